@@ -3,18 +3,54 @@
 #include <math.h>
 #include <omp.h>
 #include <stdio.h>
+#include <string.h>
 
 bitter *create_bitter(unsigned long long n) {
 	bitter *b = malloc(sizeof(bitter));
+	if (b == NULL) {
+		return NULL;
+	}
 	b->origN = n;
 	b->effectiveN = ceil(n / 8.0);
 	b->data = malloc(b->effectiveN);
 	if (b->data == NULL) {
+		free(b);
 		return NULL;
 	}
 	return b;
 }
 
+int resize_bitter(bitter *b, unsigned long long n, __uint128_t val) {
+	if (val != 0 && val != 1) {
+		return -2; // unsupported val
+	}
+	unsigned long long effectiveN = ceil(n / 8.0);
+	__uint8_t *data = realloc(b->data, effectiveN ? effectiveN : 1);
+	if (data == NULL) {
+		return -1; // b is left untouched
+	}
+	b->data = data;
+
+	unsigned long long old = b->origN;
+	b->origN = n;
+	b->effectiveN = effectiveN;
+	if (n <= old) {
+		return 0;
+	}
+	// bits up to the next byte boundary, then whole bytes
+	for (; old < n && old % 8 != 0; old++) {
+		setbit(b, old, val);
+	}
+	if (old < n) {
+		memset(b->data + old / 8, val ? 0xFF : 0x0, effectiveN - old / 8);
+	}
+	return 0;
+}
+
+unsigned long long bitter_bytes(unsigned long long n) {
+	return sizeof(bitter) + (n + 7) / 8;
+}
+
 int fill(bitter *b, __uint128_t val) {
 	if (val == 1) {
 		for (unsigned long i = 0; i < b->effectiveN; i++) {
@@ -69,6 +105,27 @@ __int8_t getbit(bitter *b, unsigned long long n) {
 	return (b->data[byte] >> offset) & 1;
 }
 
+unsigned long long count_ones(bitter *b, unsigned long long from, unsigned long long to) {
+	if (to > b->origN) {
+		to = b->origN;
+	}
+	unsigned long long c = 0;
+	// leading bits up to the first byte boundary
+	while (from < to && from % 8 != 0) {
+		c += getbit(b, from++);
+	}
+	// whole bytes
+	unsigned long long last_byte = to / 8;
+	for (unsigned long long byte = from / 8; byte < last_byte; byte++) {
+		c += __builtin_popcount(b->data[byte]);
+	}
+	// trailing bits past the last byte boundary
+	for (from = from > last_byte * 8 ? from : last_byte * 8; from < to; from++) {
+		c += getbit(b, from);
+	}
+	return c;
+}
+
 void delete_bitter(bitter *b) {
 	if (b == NULL) {
 		return;
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -25,10 +27,35 @@ typedef struct {
  */
 bitter *create_bitter(unsigned long long n);
 
+/**
+ * @brief Grow or shrink a bitter object to n bits
+ *
+ * Bits below min(n, old size) are preserved; new bits are set to val.
+ *
+ * @return 0 on success, -1 on realloc failure (b is left untouched),
+ *         -2 on unsupported val
+ */
+int resize_bitter(bitter *b, unsigned long long n, __uint128_t val);
+
+/**
+ * @brief Number of bytes create_bitter(n) will allocate
+ *
+ * Used to check a bitmap against a memory budget before allocating it.
+ */
+unsigned long long bitter_bytes(unsigned long long n);
+
 int fill(bitter *b, __uint128_t val);
 
 __int8_t setbit(bitter *b, unsigned long long n, __uint128_t val);
 
 __int8_t getbit(bitter *b, unsigned long long n);
 
+/**
+ * @brief Count the set bits in [from, to)
+ *
+ * Whole bytes are counted with popcount, so this is much cheaper than
+ * calling getbit() on every bit.
+ */
+unsigned long long count_ones(bitter *b, unsigned long long from, unsigned long long to);
+
 void delete_bitter(bitter *b);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Count the primes up to n with the block decomposition
+ *
+ * Every OpenMP thread sieves one contiguous n / threads block of odd
+ * numbers, using the seed primes up to sqrt(n).
+ *
+ * @return number of primes in [2, n]
+ */
+uint64_t block_sieve(uint64_t n);
@@ -0,0 +1,177 @@
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "enumerate.h"
+
+/** Value of bit i of the odd-only bitmap */
+#define BIT_VALUE(i) ((i) == 0 ? 2 : 2 * (i) + 1)
+
+static int digits(uint64_t v)
+{
+    int d = 1;
+    while (v >= 10) {
+        v /= 10;
+        d++;
+    }
+    return d;
+}
+
+/** Exclusive prefix sum in place; returns the total */
+static unsigned long long exclusive_scan(unsigned long long* a, unsigned long long len)
+{
+    unsigned long long sum = 0;
+    for (unsigned long long k = 0; k < len; k++) {
+        unsigned long long v = a[k];
+        a[k] = sum;
+        sum += v;
+    }
+    return sum;
+}
+
+uint64_t* collect_primes(bitter* b, unsigned long long n, unsigned long long* count)
+{
+    unsigned long long total = n / 2;
+    unsigned long long n_chunks = (total + ENUMERATE_CHUNK_BITS - 1) / ENUMERATE_CHUNK_BITS;
+    unsigned long long* offsets = malloc((n_chunks + 1) * sizeof(unsigned long long));
+    if (offsets == NULL)
+        return NULL;
+
+    /** pass 1: primes per chunk */
+#pragma omp parallel for schedule(static)
+    for (unsigned long long k = 0; k < n_chunks; k++) {
+        unsigned long long lo = k * ENUMERATE_CHUNK_BITS;
+        offsets[k] = count_ones(b, lo, lo + ENUMERATE_CHUNK_BITS > total ? total : lo + ENUMERATE_CHUNK_BITS);
+    }
+    *count = exclusive_scan(offsets, n_chunks);
+
+    uint64_t* primes = malloc(*count * sizeof(uint64_t) + 1);
+    if (primes == NULL) {
+        free(offsets);
+        return NULL;
+    }
+
+    /** pass 2: every chunk fills its own slice */
+#pragma omp parallel for schedule(static)
+    for (unsigned long long k = 0; k < n_chunks; k++) {
+        unsigned long long lo = k * ENUMERATE_CHUNK_BITS;
+        unsigned long long hi = lo + ENUMERATE_CHUNK_BITS > total ? total : lo + ENUMERATE_CHUNK_BITS;
+        uint64_t* out = primes + offsets[k];
+        for (unsigned long long i = lo; i < hi; i++) {
+            if (getbit(b, i))
+                *out++ = BIT_VALUE(i);
+        }
+    }
+
+    free(offsets);
+    return primes;
+}
+
+/** Write the whole buffer, at offset `at` if it is not negative */
+static int write_all(int fd, const char* buf, unsigned long long len, off_t at)
+{
+    while (len > 0) {
+        ssize_t w = at < 0 ? write(fd, buf, len) : pwrite(fd, buf, len, at);
+        if (w < 0)
+            return -1;
+        buf += w;
+        len -= w;
+        if (at >= 0)
+            at += w;
+    }
+    return 0;
+}
+
+/** Chunk k as tab-separated decimals, in a malloc'ed buffer of `len` bytes */
+static char* format_chunk(bitter* b, unsigned long long k, unsigned long long total, unsigned long long len)
+{
+    unsigned long long lo = k * ENUMERATE_CHUNK_BITS;
+    unsigned long long hi = lo + ENUMERATE_CHUNK_BITS > total ? total : lo + ENUMERATE_CHUNK_BITS;
+    char* buf = malloc(len + 1);
+    if (buf == NULL)
+        return NULL;
+
+    char* p = buf;
+    for (unsigned long long i = lo; i < hi; i++) {
+        if (getbit(b, i)) {
+            uint64_t v = BIT_VALUE(i);
+            int d = digits(v);
+            for (int j = d - 1; j >= 0; j--) {
+                p[j] = '0' + v % 10;
+                v /= 10;
+            }
+            p[d] = '\t';
+            p += d + 1;
+        }
+    }
+    return buf;
+}
+
+long long print_primes(bitter* b, unsigned long long n, int fd)
+{
+    unsigned long long total = n / 2;
+    unsigned long long n_chunks = (total + ENUMERATE_CHUNK_BITS - 1) / ENUMERATE_CHUNK_BITS;
+    unsigned long long* offsets = malloc((n_chunks + 1) * sizeof(unsigned long long));
+    if (offsets == NULL)
+        return -1;
+
+    /** pass 1: output bytes per chunk */
+    unsigned long long c = 0;
+#pragma omp parallel for schedule(static) reduction(+ \
+                                                    : c)
+    for (unsigned long long k = 0; k < n_chunks; k++) {
+        unsigned long long lo = k * ENUMERATE_CHUNK_BITS;
+        unsigned long long hi = lo + ENUMERATE_CHUNK_BITS > total ? total : lo + ENUMERATE_CHUNK_BITS;
+        unsigned long long bytes = 0;
+        for (unsigned long long i = lo; i < hi; i++) {
+            if (getbit(b, i)) {
+                bytes += digits(BIT_VALUE(i)) + 1;
+                c++;
+            }
+        }
+        offsets[k] = bytes;
+    }
+    unsigned long long size = exclusive_scan(offsets, n_chunks);
+
+    /**
+     * pwrite needs a seekable fd, and ignores its offset under O_APPEND
+     * (e.g. `>>`); otherwise fall back to in-order writes.
+     */
+    int flags = fcntl(fd, F_GETFL);
+    off_t base = flags < 0 || (flags & O_APPEND) ? -1 : lseek(fd, 0, SEEK_CUR);
+    char failed = 0;
+
+    /** pass 2: format every chunk and write it at its offset */
+    if (base >= 0) {
+#pragma omp parallel for schedule(static)
+        for (unsigned long long k = 0; k < n_chunks; k++) {
+            unsigned long long len = (k + 1 < n_chunks ? offsets[k + 1] : size) - offsets[k];
+            char* buf = format_chunk(b, k, total, len);
+            if (buf == NULL || write_all(fd, buf, len, base + offsets[k]) != 0) {
+#pragma omp atomic write
+                failed = 1;
+            }
+            free(buf);
+        }
+    } else {
+#pragma omp parallel for ordered schedule(static, 1)
+        for (unsigned long long k = 0; k < n_chunks; k++) {
+            unsigned long long len = (k + 1 < n_chunks ? offsets[k + 1] : size) - offsets[k];
+            char* buf = format_chunk(b, k, total, len);
+#pragma omp ordered
+            if (buf == NULL || write_all(fd, buf, len, -1) != 0) {
+#pragma omp atomic write
+                failed = 1;
+            }
+            free(buf);
+        }
+    }
+
+    if (base >= 0 && lseek(fd, base + size, SEEK_SET) < 0)
+        failed = 1;
+    free(offsets);
+    return failed ? -1 : (long long)c;
+}
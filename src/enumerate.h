@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "bitter.h"
+
+/** Bits of the odd-only bitmap handled by one chunk of the prefix-count pass */
+#define ENUMERATE_CHUNK_BITS (1ULL << 18)
+
+/**
+ * @brief All primes below n, in increasing order
+ *
+ * Two passes over an odd-only bitmap, as built by get_primes() (bit i stands
+ * for 2i + 1, bit 0 stands in for 2): every chunk counts its primes, an
+ * exclusive prefix sum gives each chunk its offset in the output, and the
+ * chunks are then written in parallel straight into their slots.
+ *
+ * @param b the bitmap
+ * @param n upper (exclusive) limit
+ * @param count set to the number of primes returned
+ * @return malloc'ed array or NULL on malloc failure
+ */
+uint64_t* collect_primes(bitter* b, unsigned long long n, unsigned long long* count);
+
+/**
+ * @brief Write all primes below n to fd as tab-separated decimals, in order
+ *
+ * Same two passes as collect_primes(), counting output bytes instead of
+ * primes. When fd is seekable each chunk is written with pwrite() at its own
+ * offset; otherwise (pipes, terminals, O_APPEND files) chunks are written one
+ * after the other.
+ *
+ * @return number of primes written, or -1 on malloc or I/O failure
+ */
+long long print_primes(bitter* b, unsigned long long n, int fd);
@@ -0,0 +1,109 @@
+#include <fcntl.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "enumerate.h"
+
+#define N 10000001ULL
+
+/** Odd-only bitmap of [1, n), laid out like get_primes() in main.c */
+static bitter* odd_bitmap(unsigned long long n)
+{
+    bitter* b = create_bitter(n / 2 + 1);
+    fill(b, 1);
+    for (unsigned long long i = 3; i * i <= n; i += 2) {
+        if (getbit(b, i / 2)) {
+            for (unsigned long long j = i * i; j <= n; j += 2 * i)
+                setbit(b, j / 2, 0);
+        }
+    }
+    return b;
+}
+
+/** Primes below n as "p\t" text, from a plain byte-per-number sieve */
+static char* reference_text(unsigned long long n, uint64_t** primes, unsigned long long* count)
+{
+    char* composite = calloc(n, 1);
+    char* text = malloc(n * 2 + 1);
+    *primes = malloc(n * sizeof(uint64_t));
+    *count = 0;
+    char* p = text;
+    for (unsigned long long i = 2; i < n; i++) {
+        if (composite[i])
+            continue;
+        (*primes)[(*count)++] = i;
+        p += sprintf(p, "%llu\t", i);
+        for (unsigned long long j = i * i; j < n; j += i)
+            composite[j] = 1;
+    }
+    free(composite);
+    return text;
+}
+
+/** print_primes() into a file opened with `flags`, after a one-line prefix */
+static int check_print(bitter* b, const char* expected, unsigned long long count, int flags)
+{
+    const char* path = "build/enumerate_test.out";
+    const char* prefix = "existing line\n";
+    FILE* f = fopen(path, "w");
+    fputs(prefix, f);
+    fclose(f);
+
+    int fd = open(path, O_WRONLY | flags);
+    if (!(flags & O_APPEND))
+        lseek(fd, 0, SEEK_END);
+    long long printed = print_primes(b, N, fd);
+    close(fd);
+
+    f = fopen(path, "r");
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    rewind(f);
+    char* got = malloc(size + 1);
+    got[fread(got, 1, size, f)] = '\0';
+    fclose(f);
+    remove(path);
+
+    int ok = printed == (long long)count
+        && strncmp(got, prefix, strlen(prefix)) == 0
+        && strcmp(got + strlen(prefix), expected) == 0;
+    free(got);
+    return ok ? 0 : -1;
+}
+
+int main()
+{
+    omp_set_num_threads(8);
+
+    uint64_t* primes;
+    unsigned long long count;
+    char* text = reference_text(N, &primes, &count);
+    bitter* b = odd_bitmap(N);
+
+    unsigned long long got;
+    uint64_t* collected = collect_primes(b, N, &got);
+    if (collected == NULL || got != count || memcmp(collected, primes, count * sizeof(uint64_t)) != 0) {
+        printf("failure at collect_primes()\n");
+        return -1;
+    }
+    printf("collect_primes: %llu primes, ok\n", got);
+
+    if (check_print(b, text, count, 0) != 0) {
+        printf("failure at print_primes() with pwrite\n");
+        return -1;
+    }
+    if (check_print(b, text, count, O_APPEND) != 0) {
+        printf("failure at print_primes() on an O_APPEND file\n");
+        return -1;
+    }
+    printf("print_primes: ok\n");
+
+    free(collected);
+    free(primes);
+    free(text);
+    delete_bitter(b);
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "growable.h"
+#include "timer.c"
+
+int main(int argc, char** argv)
+{
+    struct timespec start = getStart();
+
+    if (argc < 2) {
+        fprintf(stderr, "Please provide a number! Use: %s <number> [state_file]\n",
+            argv[0]);
+        return 1;
+    }
+
+    long long int n = atoll(argv[1]);
+
+    if (n < 1) {
+        fprintf(stderr,
+            "The number that was provided is too small! Please "
+            "provide an n > "
+            "0 (got %lld). \n",
+            n);
+        return 1;
+    }
+
+    const char* state = argc >= 3 ? argv[2] : NULL;
+    growable_sieve* s = NULL;
+    if (state != NULL) {
+        s = load_growable_sieve(state);
+        if (s != NULL)
+            fprintf(stderr, "Resuming from %s (sieved up to %llu).\n", state, s->limit);
+    }
+
+    if (s == NULL) {
+        s = create_growable_sieve(n);
+    } else if (extend_growable_sieve(s, n) != 0) {
+        delete_growable_sieve(s);
+        s = NULL;
+    }
+    if (s == NULL) {
+        fprintf(stderr, "Could not allocate RAM.\n");
+        return 2;
+    }
+
+    double get_primes_time = getTime(start);
+    fprintf(stderr, "done. Found %lld prime numbers.\n", count_growable_sieve(s, n));
+
+    if (state != NULL && save_growable_sieve(s, state) != 0)
+        fprintf(stderr, "[Error] Could not save state to %s\n", state);
+
+    fprintf(stderr, "[TIME] get_primes:	%f s\n", get_primes_time);
+    fprintf(stderr, "[TIME] TOTAL:		%f s\n", getTime(start));
+
+    delete_growable_sieve(s);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "growable.h"
+#include "segmented.h"
+
+/** File header: "SOEG" followed by a format version */
+#define GROWABLE_MAGIC 0x47454F53U
+#define GROWABLE_VERSION 1U
+
+growable_sieve* create_growable_sieve(unsigned long long n)
+{
+    growable_sieve* s = calloc(1, sizeof(growable_sieve));
+    if (s == NULL)
+        return NULL;
+
+    /** start from [1, 2): just the bit standing in for 2 */
+    s->bits = create_bitter(1);
+    if (s->bits == NULL) {
+        free(s);
+        return NULL;
+    }
+    fill(s->bits, 1);
+    s->limit = 2;
+
+    if (extend_growable_sieve(s, n) != 0) {
+        delete_growable_sieve(s);
+        return NULL;
+    }
+    return s;
+}
+
+/**
+ * Add the odd primes p with limit <= p * p < n as seeds. Their first multiple
+ * to mark is p * p, which lies in the range about to be sieved.
+ */
+static int add_seeds(growable_sieve* s, unsigned long long n)
+{
+    unsigned long long count;
+    uint32_t* primes = seed_primes(sqrt((double)n) + 1, &count);
+    if (primes == NULL)
+        return -1;
+
+    while (count > 0 && (unsigned long long)primes[count - 1] * primes[count - 1] >= n)
+        count--;
+    if (count <= s->n_seeds) {
+        free(primes);
+        return 0;
+    }
+
+    unsigned long long* next = realloc(s->next, count * sizeof(unsigned long long));
+    if (next == NULL) {
+        free(primes);
+        return -1;
+    }
+    s->next = next;
+    for (unsigned long long i = s->n_seeds; i < count; i++) {
+        unsigned long long p = primes[i];
+        s->next[i] = (p * p - 1) / 2;
+    }
+
+    free(s->seeds);
+    s->seeds = primes;
+    s->n_seeds = count;
+    return 0;
+}
+
+int extend_growable_sieve(growable_sieve* s, unsigned long long n)
+{
+    if (n <= s->limit)
+        return 0;
+
+    unsigned long long old_seeds = s->n_seeds;
+    if (add_seeds(s, n) != 0)
+        return -1;
+
+    unsigned long long from = s->limit / 2;
+    unsigned long long to = n / 2;
+    if (resize_bitter(s->bits, to, 1) != 0) {
+        /** forget the new seeds so the sieve stays consistent at its old limit */
+        s->n_seeds = old_seeds;
+        return -1;
+    }
+
+    /**
+     * Sieve the new range in cache-sized segments. Segment boundaries are
+     * multiples of 8 bits, so every thread owns whole bytes of the bitmap and
+     * setbit() needs no atomics. Each seed starts from its stored offset,
+     * skipped forward to the first multiple inside the segment.
+     */
+    unsigned long long seg_bits = SEGMENT_DEFAULT_BYTES * 8;
+    unsigned long long aligned = from / 8 * 8;
+    unsigned long long n_segments = (to - aligned + seg_bits - 1) / seg_bits;
+
+#pragma omp parallel for schedule(dynamic)
+    for (unsigned long long seg = 0; seg < n_segments; seg++) {
+        unsigned long long lo = aligned + seg * seg_bits;
+        unsigned long long hi = lo + seg_bits > to ? to : lo + seg_bits;
+        if (lo < from)
+            lo = from;
+
+        for (unsigned long long i = 0; i < s->n_seeds; i++) {
+            unsigned long long k = s->seeds[i];
+            unsigned long long j = s->next[i];
+            if (j < lo)
+                j += (lo - j + k - 1) / k * k;
+            for (; j < hi; j += k)
+                setbit(s->bits, j, 0);
+        }
+    }
+
+    /** carry every offset past the new end */
+    for (unsigned long long i = 0; i < s->n_seeds; i++) {
+        unsigned long long k = s->seeds[i];
+        if (s->next[i] < to)
+            s->next[i] += (to - s->next[i] + k - 1) / k * k;
+    }
+
+    s->limit = n;
+    return 0;
+}
+
+unsigned long long count_growable_sieve(growable_sieve* s, unsigned long long n)
+{
+    if (n > s->limit)
+        return 0;
+    return count_ones(s->bits, 0, n / 2);
+}
+
+int save_growable_sieve(growable_sieve* s, const char* path)
+{
+    FILE* f = fopen(path, "wb");
+    if (f == NULL)
+        return -1;
+
+    uint32_t header[2] = { GROWABLE_MAGIC, GROWABLE_VERSION };
+    uint64_t sizes[2] = { s->limit, s->n_seeds };
+    int ok = fwrite(header, sizeof(header), 1, f) == 1
+        && fwrite(sizes, sizeof(sizes), 1, f) == 1
+        && fwrite(s->seeds, sizeof(uint32_t), s->n_seeds, f) == s->n_seeds
+        && fwrite(s->next, sizeof(unsigned long long), s->n_seeds, f) == s->n_seeds
+        && fwrite(s->bits->data, 1, s->bits->effectiveN, f) == s->bits->effectiveN;
+
+    if (fclose(f) != 0)
+        ok = 0;
+    return ok ? 0 : -1;
+}
+
+growable_sieve* load_growable_sieve(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    if (f == NULL)
+        return NULL;
+
+    uint32_t header[2];
+    uint64_t sizes[2];
+    if (fread(header, sizeof(header), 1, f) != 1
+        || header[0] != GROWABLE_MAGIC || header[1] != GROWABLE_VERSION
+        || fread(sizes, sizeof(sizes), 1, f) != 1 || sizes[0] < 2) {
+        fclose(f);
+        return NULL;
+    }
+
+    growable_sieve* s = calloc(1, sizeof(growable_sieve));
+    if (s == NULL) {
+        fclose(f);
+        return NULL;
+    }
+    s->limit = sizes[0];
+
+    /**
+     * Never trust the sizes in the file: the seeds are fully determined by
+     * the limit, so recompute them and require the file to agree before
+     * reading anything sized by it.
+     */
+    s->bits = create_bitter(s->limit / 2);
+    if (s->bits == NULL || add_seeds(s, s->limit) != 0 || sizes[1] != s->n_seeds) {
+        fclose(f);
+        delete_growable_sieve(s);
+        return NULL;
+    }
+
+    uint32_t* seeds = malloc(s->n_seeds * sizeof(uint32_t) + 1);
+    int ok = seeds != NULL
+        && fread(seeds, sizeof(uint32_t), s->n_seeds, f) == s->n_seeds
+        && memcmp(seeds, s->seeds, s->n_seeds * sizeof(uint32_t)) == 0
+        && fread(s->next, sizeof(unsigned long long), s->n_seeds, f) == s->n_seeds
+        && fread(s->bits->data, 1, s->bits->effectiveN, f) == s->bits->effectiveN;
+    free(seeds);
+    fclose(f);
+
+    /** every offset must be the first odd multiple of its seed past the bitmap */
+    unsigned long long end = s->limit / 2;
+    for (unsigned long long i = 0; ok && i < s->n_seeds; i++) {
+        unsigned long long k = s->seeds[i];
+        ok = s->next[i] >= end && s->next[i] < end + k && (2 * s->next[i] + 1) % k == 0;
+    }
+
+    if (!ok) {
+        delete_growable_sieve(s);
+        return NULL;
+    }
+    return s;
+}
+
+void delete_growable_sieve(growable_sieve* s)
+{
+    if (s == NULL)
+        return;
+    delete_bitter(s->bits);
+    free(s->seeds);
+    free(s->next);
+    free(s);
+}
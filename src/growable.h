@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "bitter.h"
+
+/** @struct growable_sieve
+ *  A sieve of [1, limit) that can be extended to a larger limit without
+ *  re-sieving the range it already covers.
+ *
+ *  @var growable_sieve::bits
+ *    Odd-only bitmap: bit k stands for 2k + 1. Bit 0 (the number 1) stands in for 2.
+ *  @var growable_sieve::limit
+ *    Upper (exclusive) limit of the sieved range.
+ *  @var growable_sieve::seeds
+ *    Odd primes p with p * p < limit, in increasing order.
+ *  @var growable_sieve::next
+ *    For each seed, the bit index of its next odd multiple at or past the end of `bits`.
+ *  @var growable_sieve::n_seeds
+ *    Number of entries in seeds and next.
+ */
+typedef struct {
+    bitter* bits;
+    unsigned long long limit;
+    uint32_t* seeds;
+    unsigned long long* next;
+    unsigned long long n_seeds;
+} growable_sieve;
+
+/**
+ * @brief Create a growable sieve of [1, n)
+ *
+ * @return growable_sieve* or NULL on malloc failure
+ */
+growable_sieve* create_growable_sieve(unsigned long long n);
+
+/**
+ * @brief Extend the sieve to [1, n)
+ *
+ * Only [limit, n) is sieved, starting every seed at its stored offset;
+ * primes that become seeds for the larger limit start at their square.
+ * Does nothing if n <= limit.
+ *
+ * @return 0 on success, -1 on malloc failure (the sieve is left at its old limit)
+ */
+int extend_growable_sieve(growable_sieve* s, unsigned long long n);
+
+/**
+ * @brief Number of primes below n, for n <= limit
+ *
+ * @return the count, or 0 if n is past the sieved range
+ */
+unsigned long long count_growable_sieve(growable_sieve* s, unsigned long long n);
+
+/**
+ * @brief Write the sieve (bitmap and per-seed offsets) to a file
+ *
+ * @return 0 on success, -1 on I/O error
+ */
+int save_growable_sieve(growable_sieve* s, const char* path);
+
+/**
+ * @brief Read a sieve written by save_growable_sieve()
+ *
+ * @return growable_sieve* or NULL if the file is missing, malformed or
+ *         cannot be held in memory
+ */
+growable_sieve* load_growable_sieve(const char* path);
+
+void delete_growable_sieve(growable_sieve* s);
@@ -0,0 +1,67 @@
+#include <omp.h>
+#include <stdio.h>
+
+#include "growable.h"
+
+/** pi(10^k) for k = 3, 6, 8 */
+static const unsigned long long limits[] = { 1000, 1000000, 100000000 };
+static const unsigned long long expected[] = { 168, 78498, 5761455 };
+
+int main()
+{
+    /** more threads than cores, so that lost bitmap updates would show up */
+    omp_set_num_threads(32);
+
+    growable_sieve* s = create_growable_sieve(limits[0]);
+    if (s == NULL) {
+        printf("failure at create_growable_sieve()\n");
+        return -1;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        if (extend_growable_sieve(s, limits[i]) != 0) {
+            printf("failure at extend_growable_sieve(%llu)\n", limits[i]);
+            return -1;
+        }
+        unsigned long long c = count_growable_sieve(s, limits[i]);
+        printf("pi(%llu) = %llu\n", limits[i], c);
+        if (c != expected[i]) {
+            printf("failure: expected %llu\n", expected[i]);
+            return -1;
+        }
+    }
+
+    /** a single extension over the whole range must agree as well */
+    growable_sieve* once = create_growable_sieve(limits[2]);
+    if (once == NULL || count_growable_sieve(once, limits[2]) != expected[2]) {
+        printf("failure at create_growable_sieve(%llu)\n", limits[2]);
+        return -1;
+    }
+
+    /** round-trip through a state file, then resume */
+    const char* path = "build/growable_test.state";
+    if (save_growable_sieve(s, path) != 0) {
+        printf("failure at save_growable_sieve()\n");
+        return -1;
+    }
+    growable_sieve* loaded = load_growable_sieve(path);
+    if (loaded == NULL || extend_growable_sieve(loaded, 200000000) != 0
+        || count_growable_sieve(loaded, 200000000) != 11078937) {
+        printf("failure at load_growable_sieve() + extend\n");
+        return -1;
+    }
+
+    /** a state whose offsets do not match its limit must be rejected */
+    s->next[0] = 0;
+    if (save_growable_sieve(s, path) != 0 || load_growable_sieve(path) != NULL) {
+        printf("failure: corrupted state was accepted\n");
+        return -1;
+    }
+    remove(path);
+
+    printf("ok\n");
+    delete_growable_sieve(s);
+    delete_growable_sieve(once);
+    delete_growable_sieve(loaded);
+    return 0;
+}
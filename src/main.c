@@ -4,10 +4,16 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "bitter.h"
+#include "enumerate.h"
+#include "prime_gaps.h"
+#include "segmented.h"
 #include "timer.c"
+#include "tuning.h"
 
 void handle_papi_error(int retval)
 {
@@ -108,10 +114,24 @@ int main(int argc, char** argv)
             argv[0]);
         return 1;
     }
+    /** 1: print primes as decimal, 2: write them gap-encoded (see prime_gaps.h) */
     char print = 0;
-    if (argc == 3) {
+    if (argc >= 3) {
         print = atoi(argv[2]);
     }
+    prime_gaps* gaps = NULL;
+    /** memory budget in MiB, 0 for unlimited */
+    unsigned long long budget = 0;
+    if (argc >= 4) {
+        long long budget_mb = atoll(argv[3]);
+        if (budget_mb < 0) {
+            fprintf(stderr,
+                "The memory budget must be >= 0 MiB (got %lld). \n",
+                budget_mb);
+            return 1;
+        }
+        budget = budget_mb * 1024 * 1024;
+    }
 
     long long int n = atoll(argv[1]);
 
@@ -124,41 +144,112 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    /** written by SoE_tune; without it OpenMP and plan_sieve() defaults are used */
+    tuning_profile tuning;
+    char tuned = load_tuning(&tuning, tuning_path()) == 0;
+
+    int max_threads = 1;
 #ifdef OMP
+    /** an explicit OMP_NUM_THREADS wins over the profile */
+    if (tuned && getenv("OMP_NUM_THREADS") == NULL)
+        omp_set_num_threads(tuning.threads);
+    max_threads = omp_get_max_threads();
     fprintf(stderr, "Running with OpenMP. Using %d threads.\n",
-        omp_get_num_procs());
+        max_threads);
 #endif
 
-    bitter* b = get_primes(n);
-    if (b == NULL) {
-        fprintf(stderr, "Could not allocate RAM.\n");
-        return 2;
+    sieve_plan plan;
+    if (tuned) {
+        fprintf(stderr, "Using tuning profile %s (%s engine).\n", tuning_path(), tuning.engine);
+        if (strcmp(tuning.engine, "segmented") != 0)
+            fprintf(stderr, "[Warning] The profile recommends build/SoE_omp_block on this host.\n");
+        tuning.threads = max_threads;
+        plan = plan_tuned_sieve(n, budget, &tuning);
+    } else {
+        plan = plan_sieve(n, budget, max_threads);
+    }
+    bitter* b = NULL;
+    if (plan.full_bitmap) {
+        b = get_primes(n);
+        if (b == NULL) {
+            fprintf(stderr, "Could not allocate RAM for the full bitmap, falling back to segments.\n");
+            plan.full_bitmap = 0;
+        }
     }
 
-    double get_primes_time = getTime(start);
-    fprintf(stderr, "get_primes(%lld) has returned. Counting... ", n);
-    start2 = getStart();
-
+    double get_primes_time, count_time;
     unsigned long long c = 0;
+    if (plan.full_bitmap) {
+        get_primes_time = getTime(start);
+        fprintf(stderr, "get_primes(%lld) has returned. Counting... ", n);
+        start2 = getStart();
+
+        if (print == 2) {
+            gaps = prime_gaps_from_bitter(b, n);
+            if (gaps == NULL) {
+                fprintf(stderr, "Could not allocate RAM.\n");
+                return 2;
+            }
+            c = count_prime_gaps(gaps);
+        } else if (print == 1) {
+            /** ordered output: per-chunk sizes, prefix sum, then parallel writes */
+            fflush(stdout);
+            long long printed = print_primes(b, n, STDOUT_FILENO);
+            if (printed < 0) {
+                fprintf(stderr, "[Error] Could not print the primes\n");
+                return 2;
+            }
+            c = printed;
+        } else {
 #pragma omp parallel for reduction(+ \
                                    : c)
-    for (long long int i = 1; i < n; i += 2) {
-        if (getbit(b, i / 2) == 1) {
-            if (print)
-                printf("%lld\t", i);
-            c++;
+            for (long long int i = 1; i < n; i += 2) {
+                if (getbit(b, i / 2) == 1)
+                    c++;
+            }
+        }
+        count_time = getTime(start2);
+    } else {
+        fprintf(stderr,
+            "Streaming %llu-byte segments on %d threads (budget: %llu bytes)... ",
+            plan.segment_bytes, plan.threads, plan.budget);
+        long long found = -1;
+        if (print == 2) {
+            /** the list is written at the end, so it is not bounded by the budget */
+            if (plan.budget != 0)
+                fprintf(stderr, "(the prime list for print=2 is kept in RAM outside the budget) ");
+            gaps = create_prime_gaps();
         }
+        if (print != 2 || gaps != NULL)
+            found = segmented_sieve(&plan, print == 1, gaps);
+        if (found < 0) {
+            fprintf(stderr, "Could not allocate RAM.\n");
+            return 2;
+        }
+        c = found;
+        /** sieving and counting are interleaved per segment */
+        get_primes_time = getTime(start);
+        count_time = 0;
     }
     fprintf(stderr, "done. Found %lld prime numbers.\n", c);
-    double count_time = getTime(start2);
+
+    if (gaps != NULL) {
+        fprintf(stderr, "Writing %llu bytes of gaps and %llu checkpoints.\n",
+            gaps->size, gaps->n_checkpoints);
+        if (write_prime_gaps(gaps, stdout) != 0)
+            fprintf(stderr, "[Error] Could not write the prime list\n");
+        delete_prime_gaps(gaps);
+    }
 
     ret = PAPI_stop(EventSet, values);
     if (ret != PAPI_OK)
         fprintf(stderr, "[Error] PAPI Stop\n");
-    printf("L1 DCM: %lld \n", values[0]);
-    printf("L2 DCM: %lld \n", values[1]);
-    printf("L1 DCH: %lld \n", values[2]);
-    printf("L2 DCH: %lld \n", values[3]);
+    /** keep the binary prime list on stdout readable by read_prime_gaps() */
+    FILE* report = print == 2 ? stderr : stdout;
+    fprintf(report, "L1 DCM: %lld \n", values[0]);
+    fprintf(report, "L2 DCM: %lld \n", values[1]);
+    fprintf(report, "L1 DCH: %lld \n", values[2]);
+    fprintf(report, "L2 DCH: %lld \n", values[3]);
 
     fprintf(stderr, "[TIME] get_primes:	%f s\n", get_primes_time);
     fprintf(stderr, "[TIME] count:		%f s\n", count_time);
@@ -0,0 +1,288 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prime_gaps.h"
+
+/** File header: "SOEP" followed by a format version */
+#define GAPS_MAGIC 0x50454F53U
+#define GAPS_VERSION 1U
+
+/** Marks a halved gap that does not fit in one byte */
+#define GAPS_ESCAPE 0
+
+prime_gaps* create_prime_gaps()
+{
+    return calloc(1, sizeof(prime_gaps));
+}
+
+static int reserve_gaps(prime_gaps* g, unsigned long long bytes)
+{
+    if (g->size + bytes <= g->capacity)
+        return 0;
+    unsigned long long capacity = g->capacity ? g->capacity * 2 : 4096;
+    while (capacity < g->size + bytes)
+        capacity *= 2;
+    uint8_t* gaps = realloc(g->gaps, capacity);
+    if (gaps == NULL)
+        return -1;
+    g->gaps = gaps;
+    g->capacity = capacity;
+    return 0;
+}
+
+static int push_checkpoint(prime_gaps* g, uint64_t value)
+{
+    if (g->n_checkpoints == g->checkpoints_capacity) {
+        unsigned long long capacity = g->checkpoints_capacity ? g->checkpoints_capacity * 2 : 64;
+        gaps_checkpoint* checkpoints = realloc(g->checkpoints, capacity * sizeof(gaps_checkpoint));
+        if (checkpoints == NULL)
+            return -1;
+        g->checkpoints = checkpoints;
+        g->checkpoints_capacity = capacity;
+    }
+    g->checkpoints[g->n_checkpoints].value = value;
+    g->checkpoints[g->n_checkpoints].offset = g->size;
+    g->n_checkpoints++;
+    return 0;
+}
+
+int append_prime_gap(prime_gaps* g, uint64_t p)
+{
+    if (p == 2 && !g->has_two && g->n_odd == 0) {
+        g->has_two = 1;
+        return 0;
+    }
+    if (p % 2 == 0 || (g->n_odd > 0 && p <= g->last))
+        return -2;
+
+    if (g->n_odd % GAPS_CHECKPOINT_EVERY == 0) {
+        if (push_checkpoint(g, p) != 0)
+            return -1;
+    } else {
+        uint64_t half = (p - g->last) / 2;
+        if (half <= 0xFF) {
+            if (reserve_gaps(g, 1) != 0)
+                return -1;
+            g->gaps[g->size++] = half;
+        } else {
+            if (half > 0xFFFFFF || reserve_gaps(g, 4) != 0)
+                return -1;
+            g->gaps[g->size++] = GAPS_ESCAPE;
+            g->gaps[g->size++] = half & 0xFF;
+            g->gaps[g->size++] = (half >> 8) & 0xFF;
+            g->gaps[g->size++] = (half >> 16) & 0xFF;
+        }
+    }
+
+    g->last = p;
+    g->n_odd++;
+    return 0;
+}
+
+prime_gaps* prime_gaps_from_bitter(bitter* b, unsigned long long n)
+{
+    prime_gaps* g = create_prime_gaps();
+    if (g == NULL)
+        return NULL;
+
+    for (unsigned long long i = 1; i < n; i += 2) {
+        if (getbit(b, i / 2) == 1 && append_prime_gap(g, i == 1 ? 2 : i) != 0) {
+            delete_prime_gaps(g);
+            return NULL;
+        }
+    }
+    return g;
+}
+
+unsigned long long count_prime_gaps(prime_gaps* g)
+{
+    return g->has_two + g->n_odd;
+}
+
+/**
+ * Decode the first `end` odd primes of block k, starting from its checkpoint.
+ */
+static void decode_block(prime_gaps* g, unsigned long long k,
+    unsigned long long end, uint64_t* out)
+{
+    unsigned long long pos = g->checkpoints[k].offset;
+    uint64_t v = g->checkpoints[k].value;
+    if (end == 0)
+        return;
+    out[0] = v;
+
+    unsigned long long block_end = k + 1 < g->n_checkpoints ? g->checkpoints[k + 1].offset : g->size;
+    if (pos + end - 1 <= block_end) {
+        /**
+         * No escapes in the part we need: check it once, then run the sum
+         * without the per-byte escape branch. This stays a scalar, loop-carried
+         * sum: blocked shift-and-add scans (SWAR or vectorised) measured slower,
+         * as the loop is bound by the 8-byte store per prime.
+         */
+        if (memchr(g->gaps + pos, GAPS_ESCAPE, end - 1) == NULL) {
+            const uint8_t* gaps = g->gaps + pos;
+            for (unsigned long long i = 1; i < end; i++) {
+                v += 2 * (uint64_t)gaps[i - 1];
+                out[i] = v;
+            }
+            return;
+        }
+    }
+
+    for (unsigned long long i = 1; i < end; i++) {
+        uint64_t half = g->gaps[pos++];
+        if (half == GAPS_ESCAPE) {
+            half = g->gaps[pos] | (g->gaps[pos + 1] << 8) | ((uint64_t)g->gaps[pos + 2] << 16);
+            pos += 3;
+        }
+        v += 2 * half;
+        out[i] = v;
+    }
+}
+
+uint64_t prime_at(prime_gaps* g, unsigned long long i)
+{
+    uint64_t p;
+    return decode_prime_gaps(g, i, 1, &p) == 1 ? p : 0;
+}
+
+unsigned long long decode_prime_gaps(prime_gaps* g, unsigned long long first,
+    unsigned long long count, uint64_t* out)
+{
+    unsigned long long total = count_prime_gaps(g);
+    if (first >= total)
+        return 0;
+    if (count > total - first)
+        count = total - first;
+    unsigned long long written = count;
+
+    if (g->has_two) {
+        if (first == 0) {
+            *out++ = 2;
+            count--;
+        } else {
+            first--;
+        }
+    }
+    if (count == 0)
+        return written;
+
+    /** odd primes [first, last) */
+    unsigned long long last = first + count;
+    unsigned long long k_first = first / GAPS_CHECKPOINT_EVERY;
+    unsigned long long k_last = (last - 1) / GAPS_CHECKPOINT_EVERY;
+    char failed = 0;
+
+#pragma omp parallel for schedule(static)
+    for (unsigned long long k = k_first; k <= k_last; k++) {
+        unsigned long long lo = k * GAPS_CHECKPOINT_EVERY;
+        unsigned long long hi = lo + GAPS_CHECKPOINT_EVERY;
+        if (hi > last)
+            hi = last;
+
+        if (lo >= first) {
+            /** block starts inside the requested range: decode in place */
+            decode_block(g, k, hi - lo, out + (lo - first));
+        } else {
+            /** only the first block can start before the range */
+            uint64_t* buffer = malloc((hi - lo) * sizeof(uint64_t));
+            if (buffer == NULL) {
+#pragma omp atomic write
+                failed = 1;
+                continue;
+            }
+            decode_block(g, k, hi - lo, buffer);
+            memcpy(out, buffer + (first - lo), (hi - first) * sizeof(uint64_t));
+            free(buffer);
+        }
+    }
+
+    return failed ? 0 : written;
+}
+
+int write_prime_gaps(prime_gaps* g, FILE* f)
+{
+    uint32_t header[2] = { GAPS_MAGIC, GAPS_VERSION };
+    uint64_t sizes[5] = { g->has_two, g->n_odd, g->last, g->size, g->n_checkpoints };
+    int ok = fwrite(header, sizeof(header), 1, f) == 1
+        && fwrite(sizes, sizeof(sizes), 1, f) == 1
+        && fwrite(g->checkpoints, sizeof(gaps_checkpoint), g->n_checkpoints, f) == g->n_checkpoints
+        && fwrite(g->gaps, 1, g->size, f) == g->size;
+    return ok && fflush(f) == 0 ? 0 : -1;
+}
+
+/**
+ * Check that every block decodes exactly its GAPS_CHECKPOINT_EVERY - 1 gaps
+ * (fewer for the last one) between its checkpoint and the next, so that
+ * decode_block() never reads past the gap bytes of a loaded list.
+ */
+static int valid_prime_gaps(const prime_gaps* g)
+{
+    if (g->has_two > 1 || (g->n_checkpoints > 0 && g->checkpoints[0].offset != 0))
+        return 0;
+
+    for (unsigned long long k = 0; k < g->n_checkpoints; k++) {
+        unsigned long long pos = g->checkpoints[k].offset;
+        unsigned long long block_end = k + 1 < g->n_checkpoints ? g->checkpoints[k + 1].offset : g->size;
+        if (pos > block_end || block_end > g->size)
+            return 0;
+
+        unsigned long long entries = g->n_odd - k * GAPS_CHECKPOINT_EVERY;
+        if (entries > GAPS_CHECKPOINT_EVERY)
+            entries = GAPS_CHECKPOINT_EVERY;
+        for (unsigned long long i = 1; i < entries; i++) {
+            if (pos >= block_end)
+                return 0;
+            pos += g->gaps[pos] == GAPS_ESCAPE ? 4 : 1;
+        }
+        if (pos != block_end)
+            return 0;
+    }
+    return 1;
+}
+
+prime_gaps* read_prime_gaps(FILE* f)
+{
+    uint32_t header[2];
+    uint64_t sizes[5];
+    if (fread(header, sizeof(header), 1, f) != 1
+        || header[0] != GAPS_MAGIC || header[1] != GAPS_VERSION
+        || fread(sizes, sizeof(sizes), 1, f) != 1
+        || sizes[0] > 1
+        || sizes[4] != (sizes[1] + GAPS_CHECKPOINT_EVERY - 1) / GAPS_CHECKPOINT_EVERY
+        /** one to four bytes per gap, for the entries that are not checkpoints */
+        || sizes[3] < sizes[1] - sizes[4] || sizes[3] / 4 > sizes[1] - sizes[4]) {
+        return NULL;
+    }
+
+    prime_gaps* g = create_prime_gaps();
+    if (g == NULL)
+        return NULL;
+    g->has_two = sizes[0];
+    g->n_odd = sizes[1];
+    g->last = sizes[2];
+    g->size = g->capacity = sizes[3];
+    g->n_checkpoints = g->checkpoints_capacity = sizes[4];
+    g->checkpoints = malloc(g->n_checkpoints * sizeof(gaps_checkpoint) + 1);
+    g->gaps = malloc(g->size ? g->size : 1);
+
+    if (g->checkpoints == NULL || g->gaps == NULL
+        || fread(g->checkpoints, sizeof(gaps_checkpoint), g->n_checkpoints, f) != g->n_checkpoints
+        || fread(g->gaps, 1, g->size, f) != g->size
+        || !valid_prime_gaps(g)) {
+        delete_prime_gaps(g);
+        return NULL;
+    }
+    return g;
+}
+
+void delete_prime_gaps(prime_gaps* g)
+{
+    if (g == NULL)
+        return;
+    free(g->gaps);
+    free(g->checkpoints);
+    free(g);
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bitter.h"
+
+/** Every GAPS_CHECKPOINT_EVERY-th odd prime is stored as an absolute value */
+#define GAPS_CHECKPOINT_EVERY 1024ULL
+
+/** @struct gaps_checkpoint
+ *  Absolute entry point into the gap stream.
+ *
+ *  @var gaps_checkpoint::value
+ *    The odd prime at this checkpoint.
+ *  @var gaps_checkpoint::offset
+ *    Byte offset in prime_gaps::gaps of the gap to the following prime.
+ */
+typedef struct {
+    uint64_t value, offset;
+} gaps_checkpoint;
+
+/** @struct prime_gaps
+ *  A list of primes stored as byte-encoded gaps.
+ *
+ *  Gaps between odd primes are even, so half the gap is stored in one byte.
+ *  Halved gaps above 255 (none below 2^32) are stored as a 0 byte followed by
+ *  the halved gap in 3 little-endian bytes. The prime 2 is kept as a flag.
+ *  The list lives in RAM until written (about 1 byte per prime), and is not
+ *  accounted for by sieve_plan::budget.
+ *
+ *  @var prime_gaps::gaps
+ *    The gap stream.
+ *  @var prime_gaps::size
+ *    Number of bytes used in gaps.
+ *  @var prime_gaps::checkpoints
+ *    One entry per GAPS_CHECKPOINT_EVERY odd primes, for random access.
+ *  @var prime_gaps::n_checkpoints
+ *    Number of entries used in checkpoints.
+ *  @var prime_gaps::n_odd
+ *    Number of odd primes stored.
+ *  @var prime_gaps::last
+ *    Last odd prime appended.
+ *  @var prime_gaps::has_two
+ *    1 if the list starts with 2.
+ */
+typedef struct {
+    uint8_t* gaps;
+    unsigned long long size, capacity;
+    gaps_checkpoint* checkpoints;
+    unsigned long long n_checkpoints, checkpoints_capacity;
+    unsigned long long n_odd;
+    uint64_t last;
+    char has_two;
+} prime_gaps;
+
+/**
+ * @brief Create an empty prime list
+ *
+ * @return prime_gaps* or NULL on malloc failure
+ */
+prime_gaps* create_prime_gaps();
+
+/**
+ * @brief Append a prime larger than every prime already in the list
+ *
+ * @return 0 on success, -1 on malloc failure, -2 if p is out of order
+ */
+int append_prime_gap(prime_gaps* g, uint64_t p);
+
+/**
+ * @brief Encode the primes of an odd-only bitmap, as built by get_primes()
+ *
+ * Bit i stands for 2i + 1, and bit 0 (the number 1) stands in for 2.
+ *
+ * @param b the bitmap
+ * @param n upper (exclusive) limit
+ * @return prime_gaps* or NULL on malloc failure
+ */
+prime_gaps* prime_gaps_from_bitter(bitter* b, unsigned long long n);
+
+/** @brief Number of primes in the list */
+unsigned long long count_prime_gaps(prime_gaps* g);
+
+/**
+ * @brief The i-th prime of the list (0-based)
+ *
+ * Starts at the nearest checkpoint, so it decodes at most
+ * GAPS_CHECKPOINT_EVERY gaps.
+ *
+ * @return the prime, or 0 if i is out of range
+ */
+uint64_t prime_at(prime_gaps* g, unsigned long long i);
+
+/**
+ * @brief Decode primes [first, first + count) into out
+ *
+ * Blocks between checkpoints are independent and are decoded in parallel.
+ *
+ * @return number of primes written (less than count at the end of the list)
+ */
+unsigned long long decode_prime_gaps(prime_gaps* g, unsigned long long first,
+    unsigned long long count, uint64_t* out);
+
+/**
+ * @brief Write the list in binary form
+ *
+ * @return 0 on success, -1 on I/O error
+ */
+int write_prime_gaps(prime_gaps* g, FILE* f);
+
+/**
+ * @brief Read a list written by write_prime_gaps()
+ *
+ * @return prime_gaps* or NULL on I/O error, malformed input or malloc failure
+ */
+prime_gaps* read_prime_gaps(FILE* f);
+
+void delete_prime_gaps(prime_gaps* g);
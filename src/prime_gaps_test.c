@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "prime_gaps.h"
+
+#define N 2000000ULL
+
+/** Reference list of the primes below n, from a plain byte-per-number sieve */
+static uint64_t* reference_primes(unsigned long long n, unsigned long long* count)
+{
+    char* composite = calloc(n, 1);
+    uint64_t* primes = malloc(n * sizeof(uint64_t));
+    *count = 0;
+    for (unsigned long long i = 2; i < n; i++) {
+        if (composite[i])
+            continue;
+        primes[(*count)++] = i;
+        for (unsigned long long j = i * i; j < n; j += i)
+            composite[j] = 1;
+    }
+    free(composite);
+    return primes;
+}
+
+/** Encode, write, read back; returns the list read from the file */
+static prime_gaps* round_trip(const uint64_t* values, unsigned long long count)
+{
+    prime_gaps* g = create_prime_gaps();
+    for (unsigned long long i = 0; i < count; i++) {
+        if (append_prime_gap(g, values[i]) != 0) {
+            printf("failure at append_prime_gap(%llu)\n", (unsigned long long)values[i]);
+            return NULL;
+        }
+    }
+
+    FILE* f = tmpfile();
+    if (f == NULL || write_prime_gaps(g, f) != 0) {
+        printf("failure at write_prime_gaps()\n");
+        return NULL;
+    }
+    delete_prime_gaps(g);
+    rewind(f);
+    g = read_prime_gaps(f);
+    fclose(f);
+    if (g == NULL)
+        printf("failure at read_prime_gaps()\n");
+    return g;
+}
+
+/** Write g as it is and read it back: NULL if read_prime_gaps() rejects it */
+static prime_gaps* reload(prime_gaps* g)
+{
+    FILE* f = tmpfile();
+    if (f == NULL || write_prime_gaps(g, f) != 0)
+        return NULL;
+    rewind(f);
+    prime_gaps* loaded = read_prime_gaps(f);
+    fclose(f);
+    return loaded;
+}
+
+/** Corrupt one field of a valid list at a time; every variant must be rejected */
+static int check_malformed(prime_gaps* g)
+{
+    prime_gaps saved = *g;
+    gaps_checkpoint first = g->checkpoints[0];
+    gaps_checkpoint second = g->checkpoints[1];
+    uint8_t byte = g->gaps[g->size - 1];
+    const char* broken[6] = { "has_two = 2", "no gap bytes", "first checkpoint offset",
+        "checkpoint offset past the end", "short last block", "escape past the end" };
+    int failed = 0;
+
+    for (int i = 0; i < 6; i++) {
+        if (i == 0) {
+            g->has_two = 2;
+        } else if (i == 1) {
+            /** two full blocks, both pointing at an empty gap array */
+            g->n_odd = 2 * GAPS_CHECKPOINT_EVERY;
+            g->n_checkpoints = 2;
+            g->size = 0;
+            g->checkpoints[1].offset = 0;
+        } else if (i == 2) {
+            g->checkpoints[0].offset = 1;
+        } else if (i == 3) {
+            g->checkpoints[1].offset = g->size + 1;
+        } else if (i == 4) {
+            g->size--;
+        } else {
+            g->gaps[g->size - 1] = 0;
+        }
+
+        prime_gaps* loaded = reload(g);
+        if (loaded != NULL) {
+            printf("failure: read_prime_gaps() accepted a list with %s\n", broken[i]);
+            delete_prime_gaps(loaded);
+            failed = 1;
+        }
+
+        *g = saved;
+        g->checkpoints[0] = first;
+        g->checkpoints[1] = second;
+        g->gaps[g->size - 1] = byte;
+    }
+    return failed ? -1 : 0;
+}
+
+/** Full decode, a range starting mid-block, and prime_at() every few entries */
+static int check(prime_gaps* g, const uint64_t* values, unsigned long long count)
+{
+    if (count_prime_gaps(g) != count) {
+        printf("failure: %llu entries, expected %llu\n", count_prime_gaps(g), count);
+        return -1;
+    }
+
+    uint64_t* out = malloc(count * sizeof(uint64_t));
+    if (decode_prime_gaps(g, 0, count, out) != count || memcmp(out, values, count * sizeof(uint64_t)) != 0) {
+        printf("failure at decode_prime_gaps() of the whole list\n");
+        return -1;
+    }
+
+    unsigned long long first = GAPS_CHECKPOINT_EVERY + 17;
+    unsigned long long len = 3 * GAPS_CHECKPOINT_EVERY + 5;
+    if (first + len > count)
+        first = len = count / 3;
+    if (decode_prime_gaps(g, first, len, out) != len || memcmp(out, values + first, len * sizeof(uint64_t)) != 0) {
+        printf("failure at decode_prime_gaps(%llu, %llu)\n", first, len);
+        return -1;
+    }
+    if (decode_prime_gaps(g, count - 2, 10, out) != 2 || out[1] != values[count - 1]) {
+        printf("failure at decode_prime_gaps() past the end\n");
+        return -1;
+    }
+
+    for (unsigned long long i = 0; i < count; i += 97) {
+        if (prime_at(g, i) != values[i]) {
+            printf("failure at prime_at(%llu)\n", i);
+            return -1;
+        }
+    }
+    if (prime_at(g, count) != 0) {
+        printf("failure at prime_at() past the end\n");
+        return -1;
+    }
+
+    free(out);
+    return 0;
+}
+
+int main()
+{
+    unsigned long long count;
+    uint64_t* primes = reference_primes(N, &count);
+    prime_gaps* g = round_trip(primes, count);
+    if (g == NULL || check(g, primes, count) != 0)
+        return -1;
+    printf("%llu primes in %llu bytes of gaps: ok\n", count, g->size);
+    if (check_malformed(g) != 0)
+        return -1;
+    printf("malformed files rejected: ok\n");
+    delete_prime_gaps(g);
+
+    /** increasing odd values with gaps above 510 every few entries, to exercise the escapes */
+    unsigned long long n_values = 5000;
+    uint64_t* values = malloc(n_values * sizeof(uint64_t));
+    values[0] = 2;
+    values[1] = 3;
+    for (unsigned long long i = 2; i < n_values; i++)
+        values[i] = values[i - 1] + (i % 7 == 0 ? 2 * 1000 : 2 * (i % 200 + 1));
+    g = round_trip(values, n_values);
+    if (g == NULL || check(g, values, n_values) != 0)
+        return -1;
+    printf("escaped gaps: ok\n");
+
+    delete_prime_gaps(g);
+    free(values);
+    free(primes);
+    return 0;
+}
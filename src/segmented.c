@@ -0,0 +1,196 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "segmented.h"
+
+unsigned long long sieve_seed_bytes(unsigned long long n)
+{
+    /** same limit and allocations as segmented_sieve() and seed_primes() */
+    unsigned long long odds = ((unsigned long long)sqrt((double)n) + 1) / 2 + 1;
+    return bitter_bytes(odds) + odds * sizeof(uint32_t);
+}
+
+unsigned long long sieve_min_budget(unsigned long long n)
+{
+    return sieve_seed_bytes(n) + bitter_bytes(SEGMENT_MIN_BYTES * 8);
+}
+
+sieve_plan plan_sieve(unsigned long long n, unsigned long long budget, int max_threads)
+{
+    return plan_sieve_segment(n, budget, max_threads, SEGMENT_DEFAULT_BYTES);
+}
+
+sieve_plan plan_sieve_segment(unsigned long long n, unsigned long long budget, int max_threads,
+    unsigned long long segment_bytes)
+{
+    sieve_plan p;
+    p.n = n;
+    p.budget = budget;
+    p.threads = max_threads < 1 ? 1 : max_threads;
+    p.segment_bytes = segment_bytes < SEGMENT_MIN_BYTES ? SEGMENT_MIN_BYTES : segment_bytes & ~7ULL;
+
+    /** odd-only bitmap, as allocated by get_primes() */
+    unsigned long long full = bitter_bytes(n / 2 + 1);
+    p.full_bitmap = budget == 0 || full <= budget;
+
+    /** no point in segments larger than the whole range */
+    unsigned long long range_bytes = (n / 2 + 7) / 8;
+    if (p.segment_bytes > range_bytes)
+        p.segment_bytes = range_bytes < SEGMENT_MIN_BYTES ? SEGMENT_MIN_BYTES : range_bytes;
+
+    /** nor in more threads than segments */
+    unsigned long long segments = (range_bytes + p.segment_bytes - 1) / p.segment_bytes;
+    if ((unsigned long long)p.threads > segments)
+        p.threads = segments < 1 ? 1 : segments;
+
+    if (budget == 0)
+        return p;
+
+    unsigned long long overhead = sieve_seed_bytes(n);
+    unsigned long long avail = budget > overhead ? budget - overhead : 0;
+    unsigned long long min_per_thread = sieve_min_budget(n) - overhead;
+
+    /** drop threads until each one can hold at least a minimal segment */
+    if (avail / p.threads < min_per_thread)
+        p.threads = avail / min_per_thread < 1 ? 1 : avail / min_per_thread;
+
+    /** then give each thread as much as the budget allows, up to the current size */
+    unsigned long long per_thread = avail / p.threads;
+    if (per_thread < bitter_bytes(p.segment_bytes * 8)) {
+        per_thread = per_thread > sizeof(bitter) ? per_thread - sizeof(bitter) : 0;
+        p.segment_bytes = per_thread & ~7ULL;
+        if (p.segment_bytes < SEGMENT_MIN_BYTES)
+            p.segment_bytes = SEGMENT_MIN_BYTES;
+    }
+
+    return p;
+}
+
+uint32_t* seed_primes(unsigned long long limit, unsigned long long* count)
+{
+    *count = 0;
+    /** bit i stands for 2i + 1 */
+    bitter* b = create_bitter(limit / 2 + 1);
+    if (b == NULL)
+        return NULL;
+    fill(b, 1);
+
+    for (unsigned long long i = 3; i * i <= limit; i += 2) {
+        if (getbit(b, i / 2)) {
+            for (unsigned long long j = i * i; j <= limit; j += 2 * i)
+                setbit(b, j / 2, 0);
+        }
+    }
+
+    uint32_t* primes = malloc((limit / 2 + 1) * sizeof(uint32_t));
+    if (primes == NULL) {
+        delete_bitter(b);
+        return NULL;
+    }
+    for (unsigned long long i = 3; i <= limit; i += 2) {
+        if (getbit(b, i / 2))
+            primes[(*count)++] = i;
+    }
+
+    delete_bitter(b);
+    return primes;
+}
+
+/**
+ * Sieve the odd numbers 2k + 1 for k in [lo, hi) into seg, bit k - lo.
+ */
+static void sieve_segment(bitter* seg, const uint32_t* seeds, unsigned long long n_seeds,
+    unsigned long long lo, unsigned long long hi)
+{
+    unsigned long long low_value = 2 * lo + 1;
+    fill(seg, 1);
+
+    for (unsigned long long i = 0; i < n_seeds; i++) {
+        unsigned long long k = seeds[i];
+        unsigned long long first = k * k;
+        if (first >= 2 * hi + 1)
+            break;
+        if (first < low_value) {
+            /** smallest odd multiple of k that is >= low_value */
+            first = (low_value + k - 1) / k * k;
+            if (first % 2 == 0)
+                first += k;
+        }
+        for (unsigned long long j = (first - 1) / 2 - lo; j < hi - lo; j += k)
+            setbit(seg, j, 0);
+    }
+}
+
+long long segmented_sieve(const sieve_plan* p, char print, prime_gaps* gaps)
+{
+    unsigned long long n_seeds;
+    uint32_t* seeds = seed_primes((unsigned long long)sqrt((double)p->n) + 1, &n_seeds);
+    if (seeds == NULL)
+        return -1;
+
+    /**
+     * the odd numbers below n are 2k + 1 for k in [0, total); below 3 there
+     * is no prime for bit 0 to stand in for
+     */
+    unsigned long long total = p->n > 2 ? p->n / 2 : 0;
+    unsigned long long seg_bits = p->segment_bytes * 8;
+    unsigned long long n_segments = (total + seg_bits - 1) / seg_bits;
+    unsigned long long c = 0;
+    char failed = 0;
+
+#pragma omp parallel num_threads(p->threads)
+    {
+        bitter* seg = create_bitter(seg_bits);
+        if (seg == NULL) {
+#pragma omp atomic write
+            failed = 1;
+        }
+
+        if (gaps == NULL && !print) {
+#pragma omp for schedule(dynamic) reduction(+ \
+                                            : c)
+            for (unsigned long long s = 0; s < n_segments; s++) {
+                if (seg == NULL)
+                    continue;
+
+                unsigned long long lo = s * seg_bits;
+                unsigned long long hi = lo + seg_bits > total ? total : lo + seg_bits;
+                sieve_segment(seg, seeds, n_seeds, lo, hi);
+                c += count_ones(seg, 0, hi - lo);
+            }
+        } else {
+            /** segments are sieved in parallel but emitted in order */
+#pragma omp for ordered schedule(dynamic) reduction(+ \
+                                                    : c)
+            for (unsigned long long s = 0; s < n_segments; s++) {
+                unsigned long long lo = s * seg_bits;
+                unsigned long long hi = lo + seg_bits > total ? total : lo + seg_bits;
+                if (seg != NULL) {
+                    sieve_segment(seg, seeds, n_seeds, lo, hi);
+                    c += count_ones(seg, 0, hi - lo);
+                }
+
+#pragma omp ordered
+                for (unsigned long long j = 0; seg != NULL && j < hi - lo; j++) {
+                    if (!getbit(seg, j))
+                        continue;
+                    unsigned long long v = lo + j == 0 ? 2 : 2 * (lo + j) + 1;
+                    if (print)
+                        printf("%llu\t", v);
+                    if (gaps != NULL && append_prime_gap(gaps, v) != 0) {
+#pragma omp atomic write
+                        failed = 1;
+                        break;
+                    }
+                }
+            }
+        }
+
+        delete_bitter(seg);
+    }
+
+    free(seeds);
+    return failed ? -1 : (long long)c;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "bitter.h"
+#include "prime_gaps.h"
+
+/** Smallest segment we are willing to sieve, in bytes of bitmap */
+#define SEGMENT_MIN_BYTES 4096ULL
+/** Segment size used when nothing else constrains it (fits in L2) */
+#define SEGMENT_DEFAULT_BYTES (256ULL * 1024)
+
+/** @struct sieve_plan
+ *  How a sieve of [1, n) should be run so that it stays inside a memory budget.
+ *
+ *  @var sieve_plan::n
+ *    Upper (exclusive) limit of the sieve.
+ *  @var sieve_plan::budget
+ *    Memory budget in bytes. 0 means unlimited.
+ *  @var sieve_plan::segment_bytes
+ *    Size of each thread's segment bitmap, in bytes. Unused when full_bitmap is set.
+ *  @var sieve_plan::threads
+ *    Number of threads that will sieve segments concurrently.
+ *  @var sieve_plan::full_bitmap
+ *    1 if the whole odd-only bitmap fits in the budget (see get_primes()),
+ *    0 if the range must be streamed in segments.
+ */
+typedef struct {
+    unsigned long long n, budget, segment_bytes;
+    int threads;
+    char full_bitmap;
+} sieve_plan;
+
+/** @brief Bytes segmented_sieve() holds for the seed primes up to sqrt(n) */
+unsigned long long sieve_seed_bytes(unsigned long long n);
+
+/** @brief Smallest budget plan_sieve() can honour: the seeds plus one minimal segment */
+unsigned long long sieve_min_budget(unsigned long long n);
+
+/**
+ * @brief Decide how to sieve [1, n) within `budget` bytes
+ *
+ * Keeps the full bitmap when it fits, otherwise splits the budget between
+ * up to `max_threads` segment bitmaps, so that
+ * threads * bitter_bytes(segment_bytes * 8) + sieve_seed_bytes(n) <= budget.
+ * Never fails: if the budget is below sieve_min_budget(n), a single-threaded
+ * plan with the minimal segment is returned and the budget is exceeded.
+ *
+ * @param n upper (exclusive) limit
+ * @param budget memory budget in bytes, 0 for unlimited
+ * @param max_threads upper bound on the number of threads to use
+ */
+sieve_plan plan_sieve(unsigned long long n, unsigned long long budget, int max_threads);
+
+/**
+ * @brief Same as plan_sieve(), starting from `segment_bytes` instead of
+ * SEGMENT_DEFAULT_BYTES (the budget may still shrink it)
+ */
+sieve_plan plan_sieve_segment(unsigned long long n, unsigned long long budget, int max_threads,
+    unsigned long long segment_bytes);
+
+/**
+ * @brief Odd primes in [3, limit], in increasing order
+ *
+ * @param limit largest value to consider
+ * @param count set to the number of primes returned
+ * @return malloc'ed array or NULL on malloc failure
+ */
+uint32_t* seed_primes(unsigned long long limit, unsigned long long* count);
+
+/**
+ * @brief Count the primes below p->n by streaming fixed-size segments
+ *
+ * Only the seed primes up to sqrt(n) and one segment per thread are kept in
+ * memory. Like the counting loop in main.c, the number 1 stands in for 2.
+ *
+ * @param p plan returned by plan_sieve()
+ * @param print if set, primes are printed in increasing order
+ * @param gaps if not NULL, primes are appended to it in increasing order
+ * @return number of primes, or -1 on malloc failure
+ */
+long long segmented_sieve(const sieve_plan* p, char print, prime_gaps* gaps);
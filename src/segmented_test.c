@@ -0,0 +1,68 @@
+#include <stdio.h>
+
+#include "segmented.h"
+
+/** Primes below n, including the edge cases around bit 0 standing in for 2 */
+static const unsigned long long limits[] = { 1, 2, 3, 4, 10, 101, 1000, 999999, 1000000, 10000001, 100000000 };
+static const unsigned long long expected[] = { 0, 0, 1, 2, 4, 25, 168, 78498, 78498, 664579, 5761455 };
+
+static const int thread_counts[] = { 1, 3, 8 };
+
+/** plan_sieve() must stay within every budget it can honour */
+static int check_budget(unsigned long long n, unsigned long long budget, int max_threads)
+{
+    sieve_plan p = plan_sieve(n, budget, max_threads);
+    if (budget < sieve_min_budget(n))
+        return 0;
+
+    unsigned long long used = p.full_bitmap
+        ? bitter_bytes(n / 2 + 1)
+        : p.threads * bitter_bytes(p.segment_bytes * 8) + sieve_seed_bytes(n);
+    if (used > budget || p.threads < 1 || p.threads > max_threads || p.segment_bytes < SEGMENT_MIN_BYTES) {
+        printf("failure at plan_sieve(%llu, %llu, %d): %d threads, %llu-byte segments, %llu bytes\n",
+            n, budget, max_threads, p.threads, p.segment_bytes, used);
+        return -1;
+    }
+    return 0;
+}
+
+int main()
+{
+    int n_limits = sizeof(limits) / sizeof(limits[0]);
+    int n_thread_counts = sizeof(thread_counts) / sizeof(thread_counts[0]);
+
+    for (int i = 0; i < n_limits; i++) {
+        unsigned long long n = limits[i];
+        /** unlimited, the smallest honoured budget, and a few in between */
+        unsigned long long budgets[] = { 0, sieve_min_budget(n), 64 * 1024, 1024 * 1024, 8 * 1024 * 1024 };
+        for (unsigned b = 0; b < sizeof(budgets) / sizeof(budgets[0]); b++) {
+            for (int t = 0; t < n_thread_counts; t++) {
+                sieve_plan p = plan_sieve(n, budgets[b], thread_counts[t]);
+                long long c = segmented_sieve(&p, 0, NULL);
+                if (c != (long long)expected[i]) {
+                    printf("failure: pi(%llu) with budget %llu and %d threads is %lld, expected %llu\n",
+                        n, budgets[b], thread_counts[t], c, expected[i]);
+                    return -1;
+                }
+            }
+        }
+        printf("pi(%llu) = %llu\n", n, expected[i]);
+    }
+
+    /** budgets from the documented minimum up, on both sides of the full bitmap */
+    const unsigned long long plan_limits[] = { 3, 1000000, 100000000, 10000000000ULL, 1ULL << 40 };
+    const int plan_threads[] = { 1, 3, 8, 64 };
+    for (unsigned i = 0; i < sizeof(plan_limits) / sizeof(plan_limits[0]); i++) {
+        unsigned long long n = plan_limits[i];
+        unsigned long long min = sieve_min_budget(n);
+        for (unsigned t = 0; t < sizeof(plan_threads) / sizeof(plan_threads[0]); t++) {
+            for (unsigned long long budget = min - 1; budget < min + (64ULL << 20); budget += budget / 3 + 1) {
+                if (check_budget(n, budget, plan_threads[t]) != 0)
+                    return -1;
+            }
+        }
+    }
+    printf("plan_sieve budgets: ok\n");
+
+    return 0;
+}
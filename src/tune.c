@@ -0,0 +1,146 @@
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "block.h"
+#include "tuning.h"
+#include "timer.c"
+
+/** Trial range used when none is given: large enough to leave the caches */
+#define TUNE_DEFAULT_N (1ULL << 27)
+/** Runs per configuration; the fastest one is kept */
+#define TUNE_RUNS 2
+
+/**
+ * Time a segmented sieve of n. plan_sieve_segment() may clamp the segment
+ * size to the range and the threads to the segment count, so the plan that
+ * actually ran is returned in `ran`.
+ */
+static double trial(unsigned long long n, int threads, unsigned long long segment_bytes, sieve_plan* ran)
+{
+    sieve_plan p = plan_sieve_segment(n, 0, threads, segment_bytes);
+    if (ran != NULL)
+        *ran = p;
+    double best = -1;
+    for (int run = 0; run < TUNE_RUNS; run++) {
+        struct timespec start = getStart();
+        if (segmented_sieve(&p, 0, NULL) < 0)
+            return -1;
+        double t = getTime(start);
+        if (best < 0 || t < best)
+            best = t;
+    }
+    fprintf(stderr, "[TUNE] segment: %8llu bytes, threads: %3d -> %f s\n",
+        p.segment_bytes, p.threads, best);
+    return best;
+}
+
+static double block_trial(unsigned long long n, int threads)
+{
+    omp_set_num_threads(threads);
+    double best = -1;
+    for (int run = 0; run < TUNE_RUNS; run++) {
+        struct timespec start = getStart();
+        block_sieve(n);
+        double t = getTime(start);
+        if (best < 0 || t < best)
+            best = t;
+    }
+    fprintf(stderr, "[TUNE] block engine,          threads: %3d -> %f s\n", threads, best);
+    return best;
+}
+
+/** Append v to the candidate list unless it is already there */
+static int add_candidate(unsigned long long* list, int len, unsigned long long v)
+{
+    for (int i = 0; i < len; i++) {
+        if (list[i] == v)
+            return len;
+    }
+    list[len] = v;
+    return len + 1;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned long long n = argc >= 2 ? strtoull(argv[1], NULL, 10) : TUNE_DEFAULT_N;
+    const char* path = argc >= 3 ? argv[2] : tuning_path();
+
+    if (n < 1024) {
+        fprintf(stderr, "The trial range is too small! Use: %s [trial_n] [profile]\n", argv[0]);
+        return 1;
+    }
+
+    tuning_profile t;
+    probe_host(&t);
+    fprintf(stderr, "L1d: %llu, L2: %llu, L3: %llu bytes. %d cores, %d CPUs.\n",
+        t.l1d_bytes, t.l2_bytes, t.l3_bytes, t.cores, t.cpus);
+
+    /**
+     * segment sizes around each cache level, tried with every CPU busy;
+     * sizes the trial range would clamp are only tried once, at their clamped size
+     */
+    unsigned long long segments[8];
+    int n_segments = 0;
+    unsigned long long sizes[] = { t.l1d_bytes, t.l2_bytes / 2, t.l2_bytes,
+        t.l3_bytes / t.cpus, SEGMENT_DEFAULT_BYTES };
+    for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (sizes[i] >= SEGMENT_MIN_BYTES)
+            n_segments = add_candidate(segments, n_segments,
+                plan_sieve_segment(n, 0, t.cpus, sizes[i]).segment_bytes);
+    }
+
+    /** warm-up run, so that page faults and frequency ramp-up do not favour later trials */
+    trial(n, t.cpus, SEGMENT_DEFAULT_BYTES, NULL);
+
+    double best = -1;
+    sieve_plan ran;
+    for (int i = 0; i < n_segments; i++) {
+        double time = trial(n, t.cpus, segments[i], &ran);
+        if (time >= 0 && (best < 0 || time < best)) {
+            best = time;
+            t.segment_bytes = ran.segment_bytes;
+            t.threads = ran.threads;
+        }
+    }
+
+    /** powers of two up to the CPU count, plus the physical core count */
+    unsigned long long threads[64];
+    int n_threads = 0;
+    for (int th = 1; th < t.cpus && n_threads < 62; th *= 2)
+        n_threads = add_candidate(threads, n_threads, th);
+    n_threads = add_candidate(threads, n_threads, t.cores);
+    n_threads = add_candidate(threads, n_threads, t.cpus);
+
+    for (int i = 0; i < n_threads; i++) {
+        double time = trial(n, threads[i], t.segment_bytes, &ran);
+        if (time >= 0 && time < best) {
+            best = time;
+            t.segment_bytes = ran.segment_bytes;
+            t.threads = ran.threads;
+        }
+    }
+
+    /** the engine of SoE_omp_block, with the tuned thread count */
+    double block_time = block_trial(n, t.threads);
+    strcpy(t.engine, block_time < best ? "block" : "segmented");
+
+    if (best < 0) {
+        fprintf(stderr, "Could not allocate RAM.\n");
+        return 2;
+    }
+
+    fprintf(stderr, "Best: %s engine, %d threads, %llu-byte segments.\n",
+        t.engine, t.threads, t.segment_bytes);
+    fprintf(stderr, "Recommended binary: build/%s\n",
+        strcmp(t.engine, "block") == 0 ? "SoE_omp_block" : "SoE_omp");
+
+    if (save_tuning(&t, path) != 0) {
+        fprintf(stderr, "[Error] Could not write the profile to %s\n", path);
+        return 2;
+    }
+    fprintf(stderr, "Profile written to %s\n", path);
+    return EXIT_SUCCESS;
+}
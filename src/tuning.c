@@ -0,0 +1,177 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tuning.h"
+
+#define SYSFS_CPU "/sys/devices/system/cpu"
+
+/** First line of a sysfs file, without the newline */
+static int read_line(const char* path, char* buf, int len)
+{
+    FILE* f = fopen(path, "r");
+    if (f == NULL)
+        return -1;
+    char* ok = fgets(buf, len, f);
+    fclose(f);
+    if (ok == NULL)
+        return -1;
+    buf[strcspn(buf, "\n")] = '\0';
+    return 0;
+}
+
+/** Parse sizes such as "48K" or "32M" */
+static unsigned long long parse_size(const char* s)
+{
+    char* end;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (*end == 'K')
+        v *= 1024;
+    else if (*end == 'M')
+        v *= 1024ULL * 1024;
+    else if (*end == 'G')
+        v *= 1024ULL * 1024 * 1024;
+    return v;
+}
+
+static void probe_caches(tuning_profile* t)
+{
+    char path[128], level[16], type[32], size[32];
+    for (int i = 0;; i++) {
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu0/cache/index%d/level", i);
+        if (read_line(path, level, sizeof(level)) != 0)
+            break;
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu0/cache/index%d/type", i);
+        if (read_line(path, type, sizeof(type)) != 0 || strcmp(type, "Instruction") == 0)
+            continue;
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu0/cache/index%d/size", i);
+        if (read_line(path, size, sizeof(size)) != 0)
+            continue;
+
+        unsigned long long bytes = parse_size(size);
+        if (strcmp(level, "1") == 0)
+            t->l1d_bytes = bytes;
+        else if (strcmp(level, "2") == 0)
+            t->l2_bytes = bytes;
+        else if (strcmp(level, "3") == 0)
+            t->l3_bytes = bytes;
+    }
+}
+
+/** Physical cores are the distinct (package, core) pairs of the online CPUs */
+static int probe_cores(int cpus)
+{
+    int* seen = malloc(cpus * 2 * sizeof(int));
+    if (seen == NULL)
+        return cpus;
+
+    int cores = 0;
+    char path[128], line[32];
+    for (int cpu = 0; cpu < cpus; cpu++) {
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/physical_package_id", cpu);
+        if (read_line(path, line, sizeof(line)) != 0)
+            break;
+        int package = atoi(line);
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/core_id", cpu);
+        if (read_line(path, line, sizeof(line)) != 0)
+            break;
+        int core = atoi(line);
+
+        int j = 0;
+        while (j < cores && (seen[2 * j] != package || seen[2 * j + 1] != core))
+            j++;
+        if (j == cores) {
+            seen[2 * cores] = package;
+            seen[2 * cores + 1] = core;
+            cores++;
+        }
+    }
+
+    free(seen);
+    return cores > 0 ? cores : cpus;
+}
+
+void probe_host(tuning_profile* t)
+{
+    memset(t, 0, sizeof(tuning_profile));
+    t->cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (t->cpus < 1)
+        t->cpus = 1;
+    t->cores = probe_cores(t->cpus);
+    probe_caches(t);
+
+    t->threads = t->cpus;
+    t->segment_bytes = t->l2_bytes ? t->l2_bytes : SEGMENT_DEFAULT_BYTES;
+    strcpy(t->engine, "segmented");
+}
+
+const char* tuning_path()
+{
+    const char* path = getenv("SOE_TUNING");
+    return path != NULL && path[0] != '\0' ? path : TUNING_DEFAULT_PATH;
+}
+
+int save_tuning(const tuning_profile* t, const char* path)
+{
+    FILE* f = fopen(path, "w");
+    if (f == NULL)
+        return -1;
+
+    fprintf(f, "# Sieve of Eratosthenes tuning profile, written by SoE_tune\n");
+    fprintf(f, "l1d_bytes=%llu\n", t->l1d_bytes);
+    fprintf(f, "l2_bytes=%llu\n", t->l2_bytes);
+    fprintf(f, "l3_bytes=%llu\n", t->l3_bytes);
+    fprintf(f, "cores=%d\n", t->cores);
+    fprintf(f, "cpus=%d\n", t->cpus);
+    fprintf(f, "threads=%d\n", t->threads);
+    fprintf(f, "segment_bytes=%llu\n", t->segment_bytes);
+    fprintf(f, "engine=%s\n", t->engine);
+
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int load_tuning(tuning_profile* t, const char* path)
+{
+    FILE* f = fopen(path, "r");
+    if (f == NULL)
+        return -1;
+
+    memset(t, 0, sizeof(tuning_profile));
+    strcpy(t->engine, "segmented");
+
+    char line[128], value[64];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char* eq = strchr(line, '=');
+        if (line[0] == '#' || eq == NULL)
+            continue;
+        *eq = '\0';
+        if (sscanf(eq + 1, "%63s", value) != 1)
+            continue;
+
+        if (strcmp(line, "l1d_bytes") == 0)
+            t->l1d_bytes = strtoull(value, NULL, 10);
+        else if (strcmp(line, "l2_bytes") == 0)
+            t->l2_bytes = strtoull(value, NULL, 10);
+        else if (strcmp(line, "l3_bytes") == 0)
+            t->l3_bytes = strtoull(value, NULL, 10);
+        else if (strcmp(line, "cores") == 0)
+            t->cores = atoi(value);
+        else if (strcmp(line, "cpus") == 0)
+            t->cpus = atoi(value);
+        else if (strcmp(line, "threads") == 0)
+            t->threads = atoi(value);
+        else if (strcmp(line, "segment_bytes") == 0)
+            t->segment_bytes = strtoull(value, NULL, 10);
+        else if (strcmp(line, "engine") == 0 && strlen(value) < sizeof(t->engine))
+            strcpy(t->engine, value);
+    }
+
+    fclose(f);
+    return t->threads > 0 ? 0 : -1;
+}
+
+sieve_plan plan_tuned_sieve(unsigned long long n, unsigned long long budget, const tuning_profile* t)
+{
+    return plan_sieve_segment(n, budget, t->threads, t->segment_bytes);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "segmented.h"
+
+/** Profile file used when SOE_TUNING is not set */
+#define TUNING_DEFAULT_PATH "soe_tuning.conf"
+
+/** @struct tuning_profile
+ *  Host description and the sieve parameters that were fastest on it.
+ *
+ *  @var tuning_profile::l1d_bytes
+ *    L1 data cache size (0 if unknown).
+ *  @var tuning_profile::l2_bytes
+ *    L2 cache size (0 if unknown).
+ *  @var tuning_profile::l3_bytes
+ *    L3 cache size (0 if unknown).
+ *  @var tuning_profile::cores
+ *    Physical cores.
+ *  @var tuning_profile::cpus
+ *    Logical CPUs.
+ *  @var tuning_profile::threads
+ *    Thread count the engines should use.
+ *  @var tuning_profile::segment_bytes
+ *    Segment size for the segmented sieve.
+ *  @var tuning_profile::engine
+ *    "segmented" (cache-sized segments, SoE_omp) or "block"
+ *    (one n / threads block per thread, SoE_omp_block).
+ */
+typedef struct {
+    unsigned long long l1d_bytes, l2_bytes, l3_bytes;
+    int cores, cpus, threads;
+    unsigned long long segment_bytes;
+    char engine[16];
+} tuning_profile;
+
+/**
+ * @brief Fill the cache sizes and core counts from sysfs
+ *
+ * Missing entries are left at 0; cores and cpus fall back to the number
+ * of online processors. The tuned fields are set to untuned defaults.
+ */
+void probe_host(tuning_profile* t);
+
+/** @brief $SOE_TUNING if set, TUNING_DEFAULT_PATH otherwise */
+const char* tuning_path();
+
+/**
+ * @brief Write a profile as key=value lines
+ *
+ * @return 0 on success, -1 on I/O error
+ */
+int save_tuning(const tuning_profile* t, const char* path);
+
+/**
+ * @brief Read a profile written by save_tuning()
+ *
+ * @return 0 on success, -1 if the file is missing or has no thread count
+ */
+int load_tuning(tuning_profile* t, const char* path);
+
+/**
+ * @brief plan_sieve() with the tuned thread count and segment size
+ *
+ * The engine is still chosen as in plan_sieve(): the full bitmap whenever
+ * it fits the budget, segments otherwise. SoE_tune does not time the full
+ * bitmap, so the profile does not override that choice.
+ */
+sieve_plan plan_tuned_sieve(unsigned long long n, unsigned long long budget, const tuning_profile* t);